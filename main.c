@@ -1,4 +1,5 @@
 #include <avr/io.h>
+#include <avr/eeprom.h>
 #include <stdbool.h>
 #include <stdint.h> // Para uint32_t, uint16_t, etc. (aunque <avr/io.h> lo puede incluir)
 #include <string.h> // Para memset
@@ -13,6 +14,47 @@
 
 #define NUM_LED_PER_COLOR   9
 #define NUM_LINES           5
+#define NUM_OUTCOMES        3   // Empate, gana rojo, gana verde
+
+#define CELL_BIT(idx)       ((uint16_t)(1u << (idx)))
+#define FULL_BOARD_MASK     ((uint16_t)((1u << NUM_LED_PER_COLOR) - 1u))
+
+// Tiempos de refresco (ms)
+#define T_CELL_MS           1   // Ranura por casilla (ocupada o vacía)
+#define T_CURSOR_MS         1   // Ranura del cursor
+#define T_CURSOR_ON_US      333 // Encendido del cursor dentro de su ranura (~1/3: más tenue que una ficha)
+#define T_LOOP_MS           1   // Retardo al final de loop()
+#define T_MASK_SLOT_MS      2   // Ranura por casilla en las animaciones
+
+// Animación de fin de juego (ms)
+#define SEQ_T_ON_MS         1000
+#define SEQ_T_OFF_MS        500
+
+#define BTN_T_REP_MIN       50  // Periodo mínimo de auto-repetición del botón
+
+// Trazas para comparar ejecuciones (p. ej. firmware en simulador vs.
+// compilación nativa). Compilar con -DGAME_TRACE=<función> y/o
+// -DPORT_TRACE=<función> (se requiere un nombre de función) y enlazar una
+// función con el prototipo indicado; solo usan tipos enteros para que puedan
+// definirse fuera de este archivo. Sin las macros no se genera código.
+// - GAME_TRACE: una vez por vuelta de loop() (tiempo, botón, juego, tablero).
+// - PORT_TRACE: en cada cambio de una línea de Charlieplexing
+//   (level: 0 = Hi-Z, 1 = LOW, 2 = HIGH), incluidas las animaciones.
+#ifdef GAME_TRACE
+#if (GAME_TRACE + 0) != 0 || (0 - GAME_TRACE - 1) != -1 // Vacía o numérica (p. ej. -DGAME_TRACE)
+#error "GAME_TRACE requiere un nombre de función: -DGAME_TRACE=<función>"
+#endif
+extern void GAME_TRACE(uint32_t t, uint8_t buttonState, uint8_t gameState,
+                       uint16_t redBoard, uint16_t greenBoard,
+                       uint8_t cursor, uint8_t currentColor);
+#endif
+
+#ifdef PORT_TRACE
+#if (PORT_TRACE + 0) != 0 || (0 - PORT_TRACE - 1) != -1 // Vacía o numérica (p. ej. -DPORT_TRACE)
+#error "PORT_TRACE requiere un nombre de función: -DPORT_TRACE=<función>"
+#endif
+extern void PORT_TRACE(uint32_t t, uint8_t line, uint8_t level);
+#endif
 
 // Estado de los LEDs
 typedef enum LedColor_tag
@@ -28,7 +70,8 @@ typedef enum ButtonState_tag
     eBtnUndefined = 0,
     eBtnShortKeyPress,
     eBtnDoubleKeyPress,
-    eBtnLongKeyPress
+    eBtnHoldRepeat,     // Paso de auto-repetición mientras se mantiene presionado
+    eBtnSelectKeyPress  // Colocar ficha (soltar-y-tocar, o doble con 2ª larga)
 } eButtonState_t;
 
 // Estado del juego
@@ -44,11 +87,18 @@ typedef enum GameState_tag
 // Estado del tablero
 typedef struct BoardState_tag
 {
-    bool gameBoard[eNumOfColors][NUM_LED_PER_COLOR];
+    uint16_t gameBoard[eNumOfColors]; // Bitboard por color: bit i = casilla i
     uint8_t cursor;
     eLedColor_t currentColor;
 } sBoardState_t;
 
+// Registro compacto de una partida: 2 jugadas por byte (nibble bajo = par)
+typedef struct GameRecord_tag
+{
+    uint8_t moves[(NUM_LED_PER_COLOR + 1) / 2];
+    uint8_t numMoves;
+} sGameRecord_t;
+
 // Describe un pin de Charlieplexing
 typedef struct Pin_tag
 {
@@ -60,9 +110,16 @@ typedef struct Pin_tag
 uint32_t milis = 0;
 
 extern void asm_delay(uint16_t mseg); // Declaración de la función asm_delay
+extern void asm_delay_us(uint16_t useg); // Retardo en microsegundos (no actualiza milis)
 
 static eGameState_t currentGameState = eGameRestart;
 static sBoardState_t boardState;
+static sGameRecord_t gameRecord;
+
+// Archivo en EEPROM: índice de partidas por apertura (1ª casilla) y resultado,
+// y el registro de la última partida. 0xFFFF = EEPROM borrada (cuenta 0).
+static uint16_t EEMEM eeOpeningStats[NUM_LED_PER_COLOR][NUM_OUTCOMES];
+static sGameRecord_t EEMEM eeLastGame;
 
 // Retardo con actualización de milis
 static inline void delay_ms(uint16_t ms)
@@ -87,11 +144,11 @@ static const uint8_t kRedPairs[NUM_LED_PER_COLOR][2] = {
     {2,3}, {1,4}, {0,4}
 };
 
-// Combinaciones ganadoras (índices de celdas)
-static const uint8_t kWins[8][3] = {
-    {0,1,2}, {3,4,5}, {6,7,8}, // Filas
-    {0,3,6}, {1,4,7}, {2,5,8}, // Columnas
-    {0,4,8}, {2,4,6}           // Diagonales
+// Combinaciones ganadoras (máscaras de bitboard)
+static const uint16_t kWins[8] = {
+    0x007, 0x038, 0x1C0, // Filas       {0,1,2} {3,4,5} {6,7,8}
+    0x049, 0x092, 0x124, // Columnas    {0,3,6} {1,4,7} {2,5,8}
+    0x111, 0x054         // Diagonales  {0,4,8} {2,4,6}
 };
 
 /*
@@ -119,6 +176,9 @@ static inline void lineHiZ(uint8_t line)
 {
     *kLines[line].port &= ~(1u << kLines[line].bit); // Latch LOW (primero para desactivar pull-up)
     *kLines[line].ddr  &= ~(1u << kLines[line].bit); // Modo entrada
+#ifdef PORT_TRACE
+    PORT_TRACE(milis, line, 0);
+#endif
 }
 
 /*
@@ -129,6 +189,9 @@ static inline void lineLow(uint8_t line)
 {
     *kLines[line].port &= ~(1u << kLines[line].bit); // Latch LOW
     *kLines[line].ddr  |=  (1u << kLines[line].bit); // Modo salida
+#ifdef PORT_TRACE
+    PORT_TRACE(milis, line, 1);
+#endif
 }
 
 /*
@@ -139,6 +202,9 @@ static inline void lineHigh(uint8_t line)
 {
     *kLines[line].port |=  (1u << kLines[line].bit); // Latch HIGH
     *kLines[line].ddr  |=  (1u << kLines[line].bit); // Modo salida
+#ifdef PORT_TRACE
+    PORT_TRACE(milis, line, 2);
+#endif
 }
 
 /*
@@ -164,9 +230,7 @@ static inline void descarga(uint8_t src, uint8_t sink)
 	// Todas las líneas como SALIDA=LOW (drena cargas).
     for (uint8_t i = 0; i < NUM_LINES; i++)
 	{
-        // Garantiza LOW en latch y luego activa salida
-        *kLines[i].port &= ~(1u << kLines[i].bit);
-        *kLines[i].ddr |=  (1u << kLines[i].bit);
+        lineLow(i); // Garantiza LOW en latch y luego activa salida
     }
 
     allHiZ();
@@ -200,6 +264,25 @@ static inline void lightCell(eLedColor_t color, uint8_t idx, uint16_t led_ms)
     descarga(src, sink);  // Blanking/descarga global para matar fantasma
 }
 
+/*
+    @brief Enciende un LED solo parte de una ranura de T_CURSOR_MS (brillo reducido).
+    El resto de la ranura se completa en Hi-Z para que su duración sea fija.
+    @param color Color del LED (eRedLed o eGreenLed)
+    @param idx Índice de la celda (0..8)
+    @param on_us Tiempo encendido en microsegundos (< T_CURSOR_MS * 1000)
+*/
+static inline void lightCellDim(eLedColor_t color, uint8_t idx, uint16_t on_us)
+{
+    uint8_t src, sink;
+    getPair(color, idx, &src, &sink);
+
+    drivePair(src, sink);
+    asm_delay_us(on_us);
+    descarga(src, sink);
+    asm_delay_us(T_CURSOR_MS * 1000u - on_us); // Relleno en Hi-Z
+    milis += T_CURSOR_MS;
+}
+
 /*
     @brief Inicialización de los puertos y pines.
 */
@@ -229,30 +312,35 @@ void displayBoard(const sBoardState_t *bs)
     const uint32_t T_TOTAL = T_ON + T_OFF; // Periodo total
     const bool cursorOn = ((milis % T_TOTAL) < T_ON); // Cursor parpadeante
 
-    // Escaneo de las 9 casillas: rojo y verde; ~3 ms por LED encendido
+    // Escaneo de las 9 casillas: rojo y verde; ranura fija de 1 ms por casilla.
+    // Las casillas vacías también consumen su ranura para que la duración del
+    // barrido (y el brillo de cada LED) no dependa del número de fichas.
+    // Cuadro de 10 ms (~90 Hz con el retardo de loop()), sin parpadeo visible.
     for (uint8_t i = 0; i < NUM_LED_PER_COLOR; i++)
     {
-        bool red = bs->gameBoard[eRedLed][i];
-        bool green = bs->gameBoard[eGreenLed][i];
+        bool red = (bs->gameBoard[eRedLed] & CELL_BIT(i)) != 0;
+        bool green = (bs->gameBoard[eGreenLed] & CELL_BIT(i)) != 0;
 
 		if (red && green) // Ambos ocupados
             green = false; // Prioridad a rojo
         
         if (red)
-            lightCell(eRedLed, i, 3);
+            lightCell(eRedLed, i, T_CELL_MS);
         else if (green)
-            lightCell(eGreenLed, i, 3);
+            lightCell(eGreenLed, i, T_CELL_MS);
+        else
+            delay_ms(T_CELL_MS); // Ranura vacía (todo en Hi-Z)
     }
 
-    // Cursor (solo si la casilla actual está libre)
-    if (cursorOn)
-    {
-        const uint8_t c = bs->cursor;
-        const bool libre = !bs->gameBoard[eRedLed][c] && !bs->gameBoard[eGreenLed][c];
-        
-        if (libre)
-            lightCell(bs->currentColor, c, 1);
-    }
+    // Cursor (solo si la casilla actual está libre); su ranura también es fija
+    // pero solo enciende ~1/3 de ella, para distinguirlo de una ficha
+    const uint8_t c = bs->cursor;
+    const bool libre = ((bs->gameBoard[eRedLed] | bs->gameBoard[eGreenLed]) & CELL_BIT(c)) == 0;
+
+    if (cursorOn && libre)
+        lightCellDim(bs->currentColor, c, T_CURSOR_ON_US);
+    else
+        delay_ms(T_CURSOR_MS);
 
     allHiZ();
 }
@@ -265,7 +353,7 @@ void displayBoard(const sBoardState_t *bs)
 */
 static inline bool cellOccupied(const sBoardState_t *bs, uint8_t idx)
 {
-    return bs->gameBoard[eRedLed][idx] || bs->gameBoard[eGreenLed][idx];
+    return ((bs->gameBoard[eRedLed] | bs->gameBoard[eGreenLed]) & CELL_BIT(idx)) != 0;
 }
 
 /*
@@ -324,9 +412,7 @@ static bool hasWin(const sBoardState_t *bs, eLedColor_t c)
 {
     for (uint8_t w = 0; w < 8; w++)
     {
-        if (bs->gameBoard[c][kWins[w][0]] &&
-            bs->gameBoard[c][kWins[w][1]] &&
-            bs->gameBoard[c][kWins[w][2]])
+        if ((bs->gameBoard[c] & kWins[w]) == kWins[w])
         {
             return true;
         }
@@ -341,12 +427,7 @@ static bool hasWin(const sBoardState_t *bs, eLedColor_t c)
 */
 static bool boardFull(const sBoardState_t *bs)
 {
-    for (uint8_t i = 0; i < NUM_LED_PER_COLOR; i++)
-    {
-        if (!cellOccupied(bs, i))
-            return false;
-    }
-    return true;
+    return (bs->gameBoard[eRedLed] | bs->gameBoard[eGreenLed]) == FULL_BOARD_MASK;
 }
 
 /*
@@ -383,10 +464,53 @@ static eGameState_t endTurn(sBoardState_t *bs)
     return eOngoingGame;
 }
 
+/*
+    @brief Agrega una jugada al registro de la partida en curso.
+    @param idx Índice de la casilla jugada (0..8)
+*/
+static void recordMove(uint8_t idx)
+{
+    const uint8_t n = gameRecord.numMoves;
+
+    if (n >= NUM_LED_PER_COLOR)
+        return;
+
+    if ((n & 1u) == 0u)
+        gameRecord.moves[n / 2] = idx;          // Nibble bajo (limpia el alto)
+    else
+        gameRecord.moves[n / 2] |= (uint8_t)(idx << 4); // Nibble alto
+
+    gameRecord.numMoves = n + 1;
+}
+
+/*
+    @brief Archiva la partida terminada en EEPROM.
+    Actualiza el contador de apertura x resultado y guarda el registro completo.
+    Solo escribe los bytes que cambian (~3.4 ms por byte escrito).
+    @param gameState Resultado (eStalemate, eRedPlayerWin, eGreenPlayerWin)
+*/
+static void archiveGame(eGameState_t gameState)
+{
+    if (gameRecord.numMoves == 0)
+        return;
+
+    const uint8_t opening = gameRecord.moves[0] & 0x0Fu;
+    const uint8_t outcome = (uint8_t)(gameState - eStalemate);
+    uint16_t count = eeprom_read_word(&eeOpeningStats[opening][outcome]);
+
+    if (count == 0xFFFFu) // Celda nunca escrita
+        count = 0;
+    if (count < 0xFFFEu)  // Satura sin volver a parecer borrada
+        count++;
+
+    eeprom_update_word(&eeOpeningStats[opening][outcome], count);
+    eeprom_update_block(&gameRecord, &eeLastGame, sizeof(gameRecord));
+}
+
 /*
     @brief Función para verificar el estado del tablero tras una acción del jugador.
     @param boardState Estado actual del tablero
-    @param buttonState Estado del botón (presionado, doble, largo)
+    @param buttonState Estado del botón (corto, doble, repetición, selección)
     @return Estado del juego tras la acción
 */
 eGameState_t checkBoard(sBoardState_t *boardState, eButtonState_t buttonState)
@@ -399,10 +523,14 @@ eGameState_t checkBoard(sBoardState_t *boardState, eButtonState_t buttonState)
         case eBtnDoubleKeyPress:
             moveCursorToNextFree(boardState, -1);
             break;
-        case eBtnLongKeyPress:
+        case eBtnHoldRepeat:
+            moveCursorToNextFree(boardState, +1);
+            break;
+        case eBtnSelectKeyPress:
             if (!cellOccupied(boardState, boardState->cursor)) // Si la celda actual está libre
             {
-                boardState->gameBoard[boardState->currentColor][boardState->cursor] = true;
+                boardState->gameBoard[boardState->currentColor] |= CELL_BIT(boardState->cursor);
+                recordMove(boardState->cursor);
                 return endTurn(boardState);
             }
             else
@@ -450,8 +578,8 @@ static void lightMask(eLedColor_t color, const bool mask[NUM_LED_PER_COLOR], uin
 		{
             if (mask[i])
 			{
-                lightCell(color, i, 2);
-                elapsed += 2;
+                lightCell(color, i, T_MASK_SLOT_MS);
+                elapsed += T_MASK_SLOT_MS;
             }
 
             if (elapsed >= duration_ms)
@@ -497,8 +625,8 @@ static void lightX(eLedColor_t color, uint16_t  duration_ms)
 */
 bool playSequence(eGameState_t gameState)
 {
-    const uint16_t  T_ON  = 1000;    // Tiempo encendido
-    const uint16_t  T_OFF = 500;     // Tiempo apagado
+    const uint16_t  T_ON  = SEQ_T_ON_MS;  // Tiempo encendido
+    const uint16_t  T_OFF = SEQ_T_OFF_MS; // Tiempo apagado
 
     // Variables estáticas para la FSM de la animación
     static eGameState_t lastState;  // Último estado de juego
@@ -551,8 +679,15 @@ bool playSequence(eGameState_t gameState)
 
 /*
     @brief Función de chequeo del estado del botón con máquina de estados.
-    Detecta pulsaciones cortas, dobles y largas con debounce.
-    @return Estado del botón (corto, largo, doble)
+    Detecta pulsaciones cortas, dobles, mantenidas y de selección con debounce.
+    - Corta: avanza el cursor (tras expirar la ventana de doble).
+    - Doble: retrocede el cursor.
+    - Mantenida: tras T_HOLD avanza el cursor con repetición acelerada.
+    - Selección: tocar (< T_HOLD, se emite al soltar) dentro de T_DBL tras
+      soltar una mantenida que ya repitió (>= 2 pasos); mantener de nuevo
+      continúa el desplazamiento. O doble con la 2ª pulsación mantenida T_SEL2
+      (coloca en la casilla actual sin desplazar; se emite sin esperar a soltar).
+    @return Estado del botón (corto, doble, repetición, selección)
 */
 eButtonState_t checkButton(void)
 {
@@ -566,13 +701,24 @@ eButtonState_t checkButton(void)
 		S_WAIT2,
 		S_DEB_PRESS2,
 		S_PRESSED2,
-		S_DEB_RELEASE2
+		S_DEB_RELEASE2,
+		S_HOLD,
+		S_DEB_RELEASE_HOLD,
+		S_WAIT_SELECT,
+		S_DEB_SELECT,
+		S_SELECT_PRESSED,
+		S_DEB_RELEASE_SELECT,
+		S_WAIT_RELEASE
     } btn_state_t;
 
     // Umbrales (ms)
     const uint16_t T_DB   = 10;   // Debounce
-    const uint16_t T_LONG = 1000; // Long  >= 1000 ms
+    const uint16_t T_SEL2 = 300;  // 2ª pulsación >= 300 ms: selección (un toque dura < ~150 ms)
     const uint16_t T_DBL  = 500;  // Doble = 500 ms tras soltar (tiempo máximo de espera)
+    const uint16_t T_HOLD = 300;  // Mantenida >= 300 ms: inicia auto-repetición
+    const uint16_t T_REP_START = 80;  // Periodo inicial de repetición
+    const uint16_t T_REP_STEP  = 15;  // Aceleración por paso
+    const uint16_t T_REP_MIN   = BTN_T_REP_MIN; // Periodo mínimo de repetición
 
     // Lectura instantánea
     const bool pressed = ((PINB & (1U << BTN_GPIO)) == 0);
@@ -580,8 +726,8 @@ eButtonState_t checkButton(void)
     // Inicializaciones estáticas
     static btn_state_t st = S_IDLE; // Estado inicial
     static uint16_t  t0 = 0;         // Marca de tiempo para el estado actual
-    static uint16_t  dur1 = 0;       // Duración de la 1ª pulsación
-    static uint16_t  dur2 = 0;       // Duración de la 2ª pulsación
+    static uint16_t  tRep = 0;       // Periodo actual de repetición
+    static uint8_t   nRep = 0;       // Pasos emitidos en la mantenida actual
 
     switch (st)
     {
@@ -597,7 +743,7 @@ eButtonState_t checkButton(void)
             {
               st = S_IDLE; // Rebote (vuelve a IDLE)
             }
-            else if (milis - t0 >= T_DB)
+            else if ((uint16_t)(milis - t0) >= T_DB)
             {
               st = S_PRESSED; // Confirmado PRESSED
               t0 = milis;
@@ -606,23 +752,25 @@ eButtonState_t checkButton(void)
         case S_PRESSED: // Botón presionado
             if (!pressed)
             {
-              dur1 = milis - t0; // Guarda duración de la 1ª pulsación
               st = S_DEB_RELEASE; // Cambio: posible RELEASE
               t0 = milis;
             }
+            else if ((uint16_t)(milis - t0) >= T_HOLD) // Mantenida: primer paso
+            {
+              st = S_HOLD;
+              t0 = milis;
+              tRep = T_REP_START;
+              nRep = 1;
+              return eBtnHoldRepeat;
+            }
             break;
         case S_DEB_RELEASE: // Debounce de RELEASE
             if (pressed)
             {
                 st = S_PRESSED; // rebote (vuelve a PRESSED)
             }
-            else if (milis - t0 >= T_DB) // Confirmado RELEASE
+            else if ((uint16_t)(milis - t0) >= T_DB) // Confirmado RELEASE
             {
-                if (dur1 >= T_LONG) // Si fue larga
-                {
-                    st = S_IDLE; // Volver a IDLE
-                    return eBtnLongKeyPress;
-                }
                 // Corta: abrir ventana para doble
                 st = S_WAIT2;
                 t0 = milis;
@@ -634,7 +782,7 @@ eButtonState_t checkButton(void)
                 st = S_DEB_PRESS2; // Cambio: posible 2ª PRESSED
                 t0 = milis;
             }
-            else if (milis - t0 >= T_DBL)
+            else if ((uint16_t)(milis - t0) >= T_DBL)
             {
                 st = S_IDLE;
                 return eBtnShortKeyPress; // SHORT (expiró ventana)
@@ -645,7 +793,7 @@ eButtonState_t checkButton(void)
             {
                 st = S_WAIT2; // rebote (vuelve a la ventana)
             }
-            else if (milis - t0 >= T_DB)
+            else if ((uint16_t)(milis - t0) >= T_DB)
             {
                 st = S_PRESSED2;
                 t0 = milis;
@@ -654,24 +802,110 @@ eButtonState_t checkButton(void)
         case S_PRESSED2:
             if (!pressed)
             {
-                dur2 = milis - t0;
                 st = S_DEB_RELEASE2;
                 t0 = milis;
             }
+            else if ((uint16_t)(milis - t0) >= T_SEL2)
+            {
+                st = S_WAIT_RELEASE;
+                return eBtnSelectKeyPress; // SELECT (2ª pulsación mantenida)
+            }
             break;
         case S_DEB_RELEASE2:
             if (pressed) 
             {
                 st = S_PRESSED2; // rebote (vuelve a PRESSED2)
             }
-            else if (milis - t0 >= T_DB)
+            else if ((uint16_t)(milis - t0) >= T_DB)
             {
                 st = S_IDLE;
-                if (dur2 >= T_LONG)
-                    return eBtnLongKeyPress; // LONG (si la 2ª pulsación fue larga)
                 return eBtnDoubleKeyPress; // DOUBLE
             }
             break;
+        case S_HOLD: // Auto-repetición con aceleración
+            if (!pressed)
+            {
+                st = S_DEB_RELEASE_HOLD; // Cambio: posible RELEASE
+                t0 = milis;
+            }
+            else if ((uint16_t)(milis - t0) >= tRep)
+            {
+                t0 += tRep; // Mantiene la fase: el periodo medio no se redondea a vueltas de loop()
+                if (tRep > T_REP_MIN + T_REP_STEP)
+                    tRep -= T_REP_STEP; // Acelera
+                else
+                    tRep = T_REP_MIN;
+                if (nRep < 2u)
+                    nRep++;
+                return eBtnHoldRepeat;
+            }
+            break;
+        case S_DEB_RELEASE_HOLD:
+            if (pressed)
+            {
+                st = S_HOLD; // rebote (vuelve a HOLD)
+            }
+            else if ((uint16_t)(milis - t0) >= T_DB)
+            {
+                // Soltó: abrir ventana para seleccionar solo si ya hubo repetición;
+                // una pulsación apenas lenta (un paso) no debe convertir el
+                // siguiente toque en una colocación irreversible.
+                st = (nRep >= 2u) ? S_WAIT_SELECT : S_IDLE;
+                t0 = milis;
+            }
+            break;
+        case S_WAIT_SELECT:
+            if (pressed)
+            {
+                st = S_DEB_SELECT; // Cambio: posible toque de selección
+                t0 = milis;
+            }
+            else if ((uint16_t)(milis - t0) >= T_DBL)
+            {
+                st = S_IDLE; // Expiró ventana: el cursor ya se movió
+            }
+            break;
+        case S_DEB_SELECT:
+            if (!pressed)
+            {
+                st = S_WAIT_SELECT; // rebote (vuelve a la ventana)
+            }
+            else if ((uint16_t)(milis - t0) >= T_DB)
+            {
+                st = S_SELECT_PRESSED;
+                t0 = milis;
+            }
+            break;
+        case S_SELECT_PRESSED: // Toque o nueva mantenida: se decide al soltar o en T_HOLD
+            if (!pressed)
+            {
+                st = S_DEB_RELEASE_SELECT; // Cambio: posible RELEASE
+                t0 = milis;
+            }
+            else if ((uint16_t)(milis - t0) >= T_HOLD) // Sigue desplazando
+            {
+                st = S_HOLD;
+                t0 = milis; // Conserva tRep: continúa la aceleración
+                return eBtnHoldRepeat;
+            }
+            break;
+        case S_DEB_RELEASE_SELECT:
+            if (pressed)
+            {
+                st = S_SELECT_PRESSED; // rebote (vuelve a SELECT_PRESSED)
+            }
+            else if ((uint16_t)(milis - t0) >= T_DB)
+            {
+                st = S_IDLE;
+                return eBtnSelectKeyPress; // SELECT (soltar-y-tocar)
+            }
+            break;
+        case S_WAIT_RELEASE: // Ignora el resto de la 2ª pulsación de selección
+            if (!pressed)
+            {
+                st = S_IDLE;
+            }
+            break;
         default:
             st = S_IDLE; // Estado inválido: resetear
             break;
@@ -689,12 +923,64 @@ void setup(void)
 
     // Inicialización del estado del tablero (Nota: memset opera a nivel de bytes)
     memset(boardState.gameBoard, 0, sizeof(boardState.gameBoard));
+    memset(&gameRecord, 0, sizeof(gameRecord));
 
     boardState.cursor = 0;
     boardState.currentColor = eRedLed;
     currentGameState = eOngoingGame;
 }
 
+/*
+    Peor caso (WCET) de loop() por rama, como suma de términos con nombre en
+    ciclos @ 16 MHz, redondeada hacia arriba a ms. Toda llamada bloqueante que
+    se agregue a una rama debe sumar aquí su término.
+    - DELAY_CYCLES_PER_MS: asm_delay() cuesta 16008 ciclos por ms (bucle de
+      4000 x 4 - 1 más ldi/sbiw/breq/sbiw/rjmp), no 16000.
+    - SLOT_OVERHEAD_CYCLES: cada ranura encendida (lightCell/lightCellDim) hace
+      getPair, drivePair (4 accesos) y descarga (22 accesos read-modify-write
+      vía kLines con desplazamiento variable, ~55 ciclos c/u), más la llamada
+      a asm_delay (push/pop) y la suma de 32 bits en milis: ~1600 ciclos.
+    - CPU_CYCLES: cómputo sin retardos de checkButton(), checkBoard() (con
+      divisiones de wrapInc), setup() y el módulo de 32 bits de displayBoard().
+    Las cotas de ciclos son estimaciones por inspección del código (no hay
+    simulador con el que medirlas); se redondean hacia arriba con margen.
+    Con PORT_TRACE definido la sobrecarga por ranura no está acotada.
+    - eOngoingGame: CPU + displayBoard() (NUM_LED_PER_COLOR + 1 ranuras)
+      + T_LOOP_MS. Domina displayBoard().
+    - Fin de juego: CPU + playSequence() (SEQ_T_ON_MS / T_MASK_SLOT_MS + 1
+      ranuras, T_ON + 1 ranura de sobrepaso + T_OFF) + archiveGame() (última
+      vuelta) + T_LOOP_MS. Domina playSequence().
+*/
+#define CPU_CYCLES_PER_MS       16000UL
+#define DELAY_CYCLES_PER_MS     16008UL
+#define SLOT_OVERHEAD_CYCLES    2000UL
+#define CPU_CYCLES              5000UL
+#define EEPROM_WRITE_MS         4UL   // Escritura de 1 byte (3.3 ms en hoja de datos)
+
+#define WCET_MS(cycles)         (((cycles) + CPU_CYCLES_PER_MS - 1UL) / CPU_CYCLES_PER_MS)
+
+#define DISPLAY_SLOTS           (NUM_LED_PER_COLOR + 1UL)
+#define DISPLAY_DELAY_MS        ((unsigned long)NUM_LED_PER_COLOR * T_CELL_MS + T_CURSOR_MS)
+#define SEQUENCE_SLOTS          (SEQ_T_ON_MS / T_MASK_SLOT_MS + 1UL)
+#define SEQUENCE_DELAY_MS       ((unsigned long)SEQ_T_ON_MS + T_MASK_SLOT_MS + SEQ_T_OFF_MS)
+#define ARCHIVE_MS              ((sizeof(uint16_t) + sizeof(sGameRecord_t)) * EEPROM_WRITE_MS)
+
+#define WCET_DISPLAY_CYCLES     (DISPLAY_DELAY_MS * DELAY_CYCLES_PER_MS + DISPLAY_SLOTS * SLOT_OVERHEAD_CYCLES)
+#define WCET_SEQUENCE_CYCLES    (SEQUENCE_DELAY_MS * DELAY_CYCLES_PER_MS + SEQUENCE_SLOTS * SLOT_OVERHEAD_CYCLES)
+#define WCET_ARCHIVE_CYCLES     (ARCHIVE_MS * CPU_CYCLES_PER_MS)
+#define WCET_LOOP_DELAY_CYCLES  (T_LOOP_MS * DELAY_CYCLES_PER_MS)
+
+#define WCET_GAME_LOOP_MS       WCET_MS(CPU_CYCLES + WCET_DISPLAY_CYCLES + WCET_LOOP_DELAY_CYCLES)
+#define WCET_END_LOOP_MS        WCET_MS(CPU_CYCLES + WCET_SEQUENCE_CYCLES + WCET_ARCHIVE_CYCLES + WCET_LOOP_DELAY_CYCLES)
+
+// Presupuestos: cada paso de auto-repetición del botón debe verse en su propia
+// vuelta de loop(), y cada ciclo de la animación no debe alargarse más de un 10%.
+#define GAME_LOOP_BUDGET_MS     BTN_T_REP_MIN
+#define END_LOOP_BUDGET_MS      ((SEQ_T_ON_MS + SEQ_T_OFF_MS) * 11UL / 10UL)
+
+_Static_assert(WCET_GAME_LOOP_MS <= GAME_LOOP_BUDGET_MS, "loop() excede el presupuesto de entrada");
+_Static_assert(WCET_END_LOOP_MS <= END_LOOP_BUDGET_MS, "loop() excede el presupuesto de la animación");
+
 /*
     @brief Bucle principal del juego.
 */
@@ -715,6 +1001,7 @@ void loop(void)
         case eStalemate:
             if (playSequence(currentGameState)) // Si la animación terminó
             {
+                archiveGame(currentGameState); // Fuera del camino de entrada
                 setup(); // Reiniciar el juego
             }
             break;
@@ -723,5 +1010,11 @@ void loop(void)
             break;
     }
 	
-    delay_ms(1);
+#ifdef GAME_TRACE
+    GAME_TRACE(milis, (uint8_t)buttonState, (uint8_t)currentGameState,
+               boardState.gameBoard[eRedLed], boardState.gameBoard[eGreenLed],
+               boardState.cursor, (uint8_t)boardState.currentColor);
+#endif
+
+    delay_ms(T_LOOP_MS);
 }
\ No newline at end of file